@@ -12,9 +12,11 @@
  *
  * 1. Generate an Enum called `STOCK` with assigned values.
  * 2. Generate a count constant (`STOCK_count`) and range bound (`STOCK_total`).
- * 3. Generate parallel data maps: price, sector, market cap, dividend yield,
+ * 3. Generate parallel data maps: price, market cap, dividend yield,
  *    P/E ratio, EPS, 52-week high/low, beta, and average volume.
- * 4. Ensure memory safety using `ENUM_IS_VALID()`.
+ * 4. Resolve the sector column to a separate `SECTOR` enum (a foreign key),
+ *    so grouping by sector is array indexing instead of `strcmp`.
+ * 5. Ensure memory safety using `ENUM_IS_VALID()`.
  * 
  * ============================================================================
  */
@@ -30,19 +32,28 @@
  * relational attributes into a single generator macro.
  * 
  * Data Schema (Tuple format passed to X):
- * X(G, ENUM_MEMBER, ID_VALUE, PRICE, SECTOR_NAME, MARKET_CAP_BILLIONS)
+ * X(G, ENUM_MEMBER, ID_VALUE, PRICE, SECTOR, MARKET_CAP_BILLIONS, ...)
+ *
+ * The SECTOR column refers to members of `SECTOR_ENUM`, defined first.
  */
+#define SECTOR_ENUM(X, G) \
+    X(G, SECTOR_TECH,     "Technology") \
+    X(G, SECTOR_COMM,     "Communication") \
+    X(G, SECTOR_CONSUMER, "Consumer Cyclical") \
+    X(G, SECTOR_FIN,      "Financials") \
+    X(G, SECTOR_HEALTH,   "Healthcare")
+
 #define STOCK_ENUM(X, G) \
-    X(G, AAPL,  1,  180.50f, "Technology", 2800, 0.53f, 28.5f, 6.13f, 199.62f, 164.08f, 1.30f, 55000000) \
-    X(G, MSFT,  2,  415.50f, "Technology", 3100, 0.74f, 36.2f, 11.06f, 415.50f, 280.50f, 0.90f, 25000000) \
-    X(G, GOOGL, 3,  145.20f, "Communication", 1800, 0.00f, 25.1f, 5.80f, 153.78f, 102.63f, 1.05f, 30000000) \
-    X(G, AMZN,  4,  175.35f, "Consumer Cyclical", 1850, 0.00f, 60.5f, 2.90f, 175.39f, 96.29f, 1.15f, 40000000) \
-    X(G, NVDA,  5,  850.10f, "Technology", 2100, 0.02f, 75.3f, 11.93f, 974.00f, 262.20f, 1.70f, 45000000) \
-    X(G, META,  6,  480.00f, "Communication", 1200, 0.42f, 32.7f, 14.87f, 503.20f, 207.13f, 1.25f, 20000000) \
-    X(G, TSLA,  7,  190.50f, "Consumer Cyclical", 600, 0.00f, 45.8f, 4.30f, 299.29f, 152.37f, 2.30f, 100000000) \
-    X(G, BRK_B, 8,  410.20f, "Financials", 880, 0.00f, 0.0f, 4.50f, 420.00f, 300.00f, 0.85f, 3500000) \
-    X(G, LLY,   9,  750.00f, "Healthcare", 710, 0.70f, 120.5f, 6.30f, 800.00f, 330.00f, 0.45f, 3000000) \
-    X(G, TSM,   10, 140.00f, "Technology", 720, 1.40f, 28.3f, 5.15f, 150.00f, 85.00f, 1.10f, 12000000)
+    X(G, AAPL,  1,  180.50f, SECTOR_TECH, 2800, 0.53f, 28.5f, 6.13f, 199.62f, 164.08f, 1.30f, 55000000) \
+    X(G, MSFT,  2,  415.50f, SECTOR_TECH, 3100, 0.74f, 36.2f, 11.06f, 415.50f, 280.50f, 0.90f, 25000000) \
+    X(G, GOOGL, 3,  145.20f, SECTOR_COMM, 1800, 0.00f, 25.1f, 5.80f, 153.78f, 102.63f, 1.05f, 30000000) \
+    X(G, AMZN,  4,  175.35f, SECTOR_CONSUMER, 1850, 0.00f, 60.5f, 2.90f, 175.39f, 96.29f, 1.15f, 40000000) \
+    X(G, NVDA,  5,  850.10f, SECTOR_TECH, 2100, 0.02f, 75.3f, 11.93f, 974.00f, 262.20f, 1.70f, 45000000) \
+    X(G, META,  6,  480.00f, SECTOR_COMM, 1200, 0.42f, 32.7f, 14.87f, 503.20f, 207.13f, 1.25f, 20000000) \
+    X(G, TSLA,  7,  190.50f, SECTOR_CONSUMER, 600, 0.00f, 45.8f, 4.30f, 299.29f, 152.37f, 2.30f, 100000000) \
+    X(G, BRK_B, 8,  410.20f, SECTOR_FIN, 880, 0.00f, 0.0f, 4.50f, 420.00f, 300.00f, 0.85f, 3500000) \
+    X(G, LLY,   9,  750.00f, SECTOR_HEALTH, 710, 0.70f, 120.5f, 6.30f, 800.00f, 330.00f, 0.45f, 3000000) \
+    X(G, TSM,   10, 140.00f, SECTOR_TECH, 720, 1.40f, 28.3f, 5.15f, 150.00f, 85.00f, 1.10f, 12000000)
 
 
 /**
@@ -56,6 +67,8 @@
  * Generates: `enum STOCK` with AAPL=1 .. TSM=10, plus `STOCK_count` and
  * `STOCK_get_label`.
  */
+ENUMS_AUTOMATIC(SECTOR);
+ENUMS_ARRAY(SECTOR, SECTOR_ENUM, const char*, name);
 ENUMS_ASSIGNED(STOCK);
 
 /*
@@ -92,8 +105,10 @@ ENUMS_ASSIGNED(STOCK);
 // Generates float STOCK_get_price(int value). Extracts Index 1 from tuple.
 ENUMS_ARRAY(STOCK, STOCK_ENUM, float, price, 1);
 
-// Generates const char* STOCK_get_sector(int value). Extracts Index 2.
-ENUMS_ARRAY(STOCK, STOCK_ENUM, const char*, sector, 2);
+// Generates int STOCK_get_sector_id(int value) and the reverse lists
+// STOCK_get_sector_members(sector, &members). Index 2 must name SECTOR members;
+// anything else is a compile error.
+ENUMS_FOREIGN_KEY(STOCK, STOCK_ENUM, SECTOR, sector, 2);
 
 // Generates int STOCK_get_mcap(int value). Extracts Index 3.
 ENUMS_ARRAY(STOCK, STOCK_ENUM, int, mcap, 3);
@@ -129,6 +144,13 @@ ENUMS_ARRAY(STOCK, STOCK_ENUM, int, avg_vol, 10);
  */
 ENUM_TO_STRING(STOCK);
 
+/*
+ * Registers `int STOCK_sample(enumfactory_rng* rng)`, which draws a stock
+ * with probability proportional to its average volume (Index 10), e.g. to
+ * generate a realistic synthetic order flow.
+ */
+ENUMS_SAMPLER(STOCK, STOCK_ENUM, 10);
+
 
 /**
  * ----------------------------------------------------------------------------
@@ -167,7 +189,7 @@ int main(void) {
             STOCK_to_string(i),
             i,
             STOCK_get_price(i),
-            STOCK_get_sector(i),
+            SECTOR_get_name(STOCK_get_sector_id(i)),
             STOCK_get_mcap(i),
             STOCK_get_div_yield(i),
             STOCK_get_pe_ratio(i),
@@ -182,5 +204,35 @@ int main(void) {
     printf("--------------------------------------------------------------------------------------------------------------------------------------\n");
     printf("Total valid stocks defined: %d\n", STOCK_count); // Always equates perfectly to 10.
 
+    /*
+     * Grouping by sector:
+     * The reverse lists are grouped at compile time, so each sector's
+     * members are one contiguous slice with no string comparisons.
+     */
+    printf("\n=== Market Cap by Sector ===\n");
+    for (int s = 0; s < ENUM_COUNT(SECTOR); s++) {
+        const int* members;
+        size_t n = STOCK_get_sector_members(s, &members);
+        int mcap = 0;
+        for (size_t k = 0; k < n; k++) {
+            mcap += STOCK_get_mcap(members[k]);
+        }
+        printf("%-18s | %zu stocks | $%d B\n", SECTOR_get_name(s), n, mcap);
+    }
+
+    /*
+     * Volume-weighted order flow:
+     * A fixed seed makes the simulated flow reproducible between runs.
+     */
+    printf("\n=== Simulated Orders (volume weighted) ===\n");
+    enumfactory_rng rng;
+    enumfactory_rng_seed(&rng, 2024);
+    int orders[8];
+    STOCK_sample_batch(&rng, orders, 8);
+    for (int k = 0; k < 8; k++) {
+        printf("%s%s", k ? ", " : "", STOCK_to_string(orders[k]));
+    }
+    printf("\n");
+
     return 0;
 }
@@ -29,6 +29,12 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ENUMFACTORY_THREADS
+#include <pthread.h>
+#endif
 
 /*-----------------------------------------------------------------------------
  * Base Enum Generation Macros
@@ -52,6 +58,10 @@
  * ENUM_SWITCH_CASE_VAL_: Switch-case generator extracting the first variadic
  *       argument. Equivalent to ENUM_SWITCH_CASE_VAL_0.
  *       Example expansion: case RED: return "FF0000";
+ *
+ * ENUM_LABEL_ / ENUM_LABEL_LEN_: The label of a member and its length, for
+ *       tables indexed by dense index or bit position.
+ *       Example expansion: "RED" / (sizeof("RED") - 1)
  */
 #define ENUM(_1, ...) _1
 #define ENUM_VALUE_ASSIGN(_1, _2, ...) _1 = _2
@@ -59,6 +69,8 @@
 #define ENUM_VALUE_MAP_VAL_(_val, ...) _val
 #define ENUM_SWITCH_CASE_LABEL_(_1, ...) case _1: return #_1;
 #define ENUM_SWITCH_CASE_VAL_(_1, ...) case _1: return ENUM_VALUE_MAP_VAL_(__VA_ARGS__, _1);
+#define ENUM_LABEL_(_1, ...) #_1
+#define ENUM_LABEL_LEN_(_1, ...) (sizeof(#_1) - 1)
 
 #define ENUM_VALUE_MAP_VAL_0(_0, ...) _0
 #define ENUM_VALUE_MAP_VAL_1(_0, _1, ...) _1
@@ -85,6 +97,33 @@
 #define ENUM_SWITCH_CASE_VAL_9(_1, ...) case _1: return ENUM_VALUE_MAP_VAL_9(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 #define ENUM_SWITCH_CASE_VAL_10(_1, ...) case _1: return ENUM_VALUE_MAP_VAL_10(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 
+/* ENUM_COLUMN_: Column _index (0-10) of a member's data, zero-padded like
+ * ENUM_SWITCH_CASE_VAL_N. Takes the member first, so it can be passed as
+ * the X argument of a list with the column index as G.
+ *       Example expansion (index 1, X(G, RED, "FF0000", 3)): 3
+ */
+#define ENUM_COLUMN_(_index, _1, ...) \
+    ENUMS_CONCAT_(ENUM_VALUE_MAP_VAL_, _index)(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+
+/* Dense Index Generators
+ * ----------------------
+ * These are passed as the X argument of a list, with the enum name as G, so
+ * that every member can be paired with its position in the list.
+ *
+ * ENUM_INDEX_DECL_: Declares the dense index constant of a member.
+ *       Example expansion: STATUS_idx_NOT_FOUND,
+ *
+ * ENUM_SWITCH_CASE_INDEX_: Switch-case mapping a value to its dense index.
+ *       Example expansion: case NOT_FOUND: return STATUS_idx_NOT_FOUND;
+ *
+ * ENUM_DENSE_SLOT_: Designated initializer mapping a value to its dense
+ *       index + 1, leaving 0 free to mean "not a member".
+ *       Example expansion: [(NOT_FOUND)] = STATUS_idx_NOT_FOUND + 1,
+ */
+#define ENUM_INDEX_DECL_(_name, _1, ...) _name ## _idx_ ## _1,
+#define ENUM_SWITCH_CASE_INDEX_(_name, _1, ...) case _1: return _name ## _idx_ ## _1;
+#define ENUM_DENSE_SLOT_(_name, _1, ...) [(_1)] = _name ## _idx_ ## _1 + 1,
+
 #define ENUMS_CONCAT_IMPL_(a, b) a ## b
 #define ENUMS_CONCAT_(a, b) ENUMS_CONCAT_IMPL_(a, b)
 
@@ -116,18 +155,44 @@
  * 3. Safe Label Accessor (_get_label)
  *    - A function to safely retrieve the string label of a value,
  *      returning NULL if out of bounds.
+ *
+ * It also numbers the members densely in list order (NAME_idx_MEMBER,
+ * 0 .. NAME_idx_total - 1) so that sparse enums can index compact tables:
+ *    - _get_index maps a value to its dense index, or -1 if invalid.
+ *    - _get_value maps a dense index back to its value, or NAME_total
+ *      if the index is out of range.
  */
 #define GENERATE_ENUM_CORE(_enum_name, _enum_list, _generator) \
 typedef enum { \
     _enum_list(X_COMMA_, _generator) \
     _enum_name ## _total \
 } _enum_name; \
+GENERATE_ENUM_INDEX_(_enum_name, _enum_list) \
+GENERATE_ENUM_ACCESSORS_(_enum_name, _enum_list)
+
+/* Building blocks of GENERATE_ENUM_CORE, shared with generators (such as
+ * ENUMS_FLAGS) that need the dense indices before the enum type itself. */
+#define GENERATE_ENUM_INDEX_(_enum_name, _enum_list) \
+enum { _enum_list(ENUM_INDEX_DECL_, _enum_name) _enum_name ## _idx_total };
+
+#define GENERATE_ENUM_ACCESSORS_(_enum_name, _enum_list) \
 static const int _enum_name ## _count = (sizeof((int[]){ _enum_list(ENUM_VAL_COUNT_, 0) 0 }) / sizeof(int)) - 1; \
 static inline const char* _enum_name ## _get_label(int value) { \
     switch(value) { \
         _enum_list(X_CALL_, ENUM_SWITCH_CASE_LABEL_) \
         default: return NULL; \
     } \
+} \
+static inline int _enum_name ## _get_index(int value) { \
+    switch(value) { \
+        _enum_list(ENUM_SWITCH_CASE_INDEX_, _enum_name) \
+        default: return -1; \
+    } \
+} \
+static inline int _enum_name ## _get_value(int index) { \
+    static const int values_[] = { _enum_list(X_COMMA_, ENUM) 0 }; \
+    return (index >= 0 && index < _enum_name ## _idx_total) \
+        ? values_[index] : (int)_enum_name ## _total; \
 }
 
 #define ENUM_TOTAL(_enum) _enum ## _total
@@ -181,6 +246,992 @@ static inline _type _enum_name ## _get_ ## _suffix(int value) { \
 GENERATE_ENUM_CORE(_enum_name, _enum_list, _generator) \
 ENUMS_ARRAY(_enum_name, _enum_list, _type, _suffix)
 
+/*-----------------------------------------------------------------------------
+ * Foreign Keys
+ * Columns whose entries are members of another generated enum
+ *-----------------------------------------------------------------------------*/
+
+/* Foreign Key Generators
+ * ----------------------
+ * The lists are walked with a context tuple as G, e.g. (STOCK, sector, 2).
+ * ENUM_FK_APPLY_/ENUM_FK_APPLY2_ splice such a tuple into an argument list;
+ * two copies exist because the group walk nests inside the target walk.
+ *
+ * ENUM_FK_CHECKED_: Evaluates to the referenced target value, but also names
+ *       TARGET_idx_<ref>, so a reference to anything that is not a member of
+ *       the target enum fails to compile.
+ *       Example expansion: (0 * SECTOR_idx_SECTOR_TECH + (int)(SECTOR_TECH))
+ *
+ * ENUM_FK_CASE_: Switch-case mapping a member to its checked reference.
+ *
+ * ENUM_FK_GROUP_/ENUM_FK_RANK_: For every target member t, walk the source
+ *       list and declare a running counter per source member m:
+ *           NAME_sfx_a_t_m, NAME_sfx_pos_t_m = NAME_sfx_a_t_m - (ref(m) != t),
+ *       The first constant auto-increments from the previous counter and the
+ *       second takes the increment back unless m references t, so
+ *       NAME_sfx_pos_<ref(m)>_m is m's slot in a list grouped by target.
+ *       Each group closes with NAME_sfx_end_t (one past its last slot) and
+ *       rewinds the counter for the next group.
+ *
+ * ENUM_FK_SLOT_: Designated initializer placing a member in its slot.
+ *       Example expansion: [STOCK_sector_pos_SECTOR_TECH_MSFT] = MSFT,
+ *
+ * ENUM_FK_END_: Designated initializer for the end offset of a group.
+ *       Example expansion: [SECTOR_idx_SECTOR_TECH + 1] = STOCK_sector_end_SECTOR_TECH,
+ */
+#define ENUM_FK_UNPACK_(...) __VA_ARGS__
+#define ENUM_FK_APPLY_(_macro, _args) _macro _args
+#define ENUM_FK_APPLY2_(_macro, _args) _macro _args
+#define ENUM_FK_PASTE3_(_a, _b, _c) _a ## _b ## _c
+#define ENUM_FK_NAME_(_a, _b, _c) ENUM_FK_PASTE3_(_a, _b, _c)
+
+#define ENUM_FK_CHECKED_(_target, _ref) ENUM_FK_CHECKED_IMPL_(_target, _ref)
+#define ENUM_FK_CHECKED_IMPL_(_target, _ref) (0 * _target ## _idx_ ## _ref + (int)(_ref))
+
+#define ENUM_FK_CASE_(_ctx, ...) ENUM_FK_APPLY_(ENUM_FK_CASE_IMPL_, (ENUM_FK_UNPACK_ _ctx, __VA_ARGS__))
+#define ENUM_FK_CASE_IMPL_(_target, _index, _1, ...) \
+    case _1: return ENUM_FK_CHECKED_(_target, ENUM_COLUMN_(_index, _1, __VA_ARGS__));
+
+#define ENUM_FK_GROUP_(_ctx, ...) ENUM_FK_APPLY_(ENUM_FK_GROUP_IMPL_, (ENUM_FK_UNPACK_ _ctx, __VA_ARGS__))
+#define ENUM_FK_GROUP_IMPL_(_enum_name, _enum_list, _suffix, _index, _t, ...) \
+    _enum_list(ENUM_FK_RANK_, (_enum_name, _suffix, _index, _t)) \
+    _enum_name ## _ ## _suffix ## _end_ ## _t, \
+    _enum_name ## _ ## _suffix ## _rewind_ ## _t = _enum_name ## _ ## _suffix ## _end_ ## _t - 1,
+
+#define ENUM_FK_RANK_(_ctx, ...) ENUM_FK_APPLY2_(ENUM_FK_RANK_IMPL_, (ENUM_FK_UNPACK_ _ctx, __VA_ARGS__))
+#define ENUM_FK_RANK_IMPL_(_enum_name, _suffix, _index, _t, _1, ...) \
+    _enum_name ## _ ## _suffix ## _a_ ## _t ## _ ## _1, \
+    _enum_name ## _ ## _suffix ## _pos_ ## _t ## _ ## _1 = \
+        _enum_name ## _ ## _suffix ## _a_ ## _t ## _ ## _1 - (ENUM_COLUMN_(_index, _1, __VA_ARGS__) != _t),
+
+#define ENUM_FK_SLOT_(_ctx, ...) ENUM_FK_APPLY_(ENUM_FK_SLOT_IMPL_, (ENUM_FK_UNPACK_ _ctx, __VA_ARGS__))
+#define ENUM_FK_SLOT_IMPL_(_enum_name, _suffix, _index, _1, ...) \
+    [ENUM_FK_NAME_(_enum_name ## _ ## _suffix ## _pos_, ENUM_COLUMN_(_index, _1, __VA_ARGS__), _ ## _1)] = _1,
+
+#define ENUM_FK_END_(_ctx, _t, ...) ENUM_FK_APPLY_(ENUM_FK_END_IMPL_, (ENUM_FK_UNPACK_ _ctx, _t))
+#define ENUM_FK_END_IMPL_(_enum_name, _target, _suffix, _t) \
+    [_target ## _idx_ ## _t + 1] = _enum_name ## _ ## _suffix ## _end_ ## _t,
+
+/* ENUMS_FOREIGN_KEY:
+ * Declares that column INDEX of LIST holds members of another generated
+ * enum TARGET (whose list is TARGET_ENUM, by the ENUMS_AUTOMATIC/ASSIGNED
+ * convention), replacing string columns that would otherwise be compared
+ * with strcmp. Generates:
+ *
+ * - NAME_get_SUFFIX_id(value): the referenced TARGET value, or TARGET_total
+ *   if value is not a member of NAME.
+ * - NAME_get_SUFFIX_members(target, &members): points members at the NAME
+ *   values that reference target (in list order) and returns how many there
+ *   are; returns 0 and sets NULL for an unknown target.
+ *
+ * Both are table lookups; the reverse lists are grouped at compile time.
+ * A reference that is not a TARGET member is a build error. LIST and
+ * TARGET_ENUM must be different macros (no self-references).
+ */
+#define ENUMS_FOREIGN_KEY(_enum_name, _enum_list, _target, _suffix, _index) \
+enum { \
+    _enum_name ## _ ## _suffix ## _rewind_ = -1, \
+    _target ## _ENUM(ENUM_FK_GROUP_, (_enum_name, _enum_list, _suffix, _index)) \
+}; \
+static inline int _enum_name ## _get_ ## _suffix ## _id(int value) { \
+    switch(value) { \
+        _enum_list(ENUM_FK_CASE_, (_target, _index)) \
+        default: return _target ## _total; \
+    } \
+} \
+static inline size_t _enum_name ## _get_ ## _suffix ## _members(int target, const int** members) { \
+    static const int members_[_enum_name ## _idx_total + 1] = { \
+        _enum_list(ENUM_FK_SLOT_, (_enum_name, _suffix, _index)) \
+    }; \
+    static const int ends_[_target ## _idx_total + 1] = { \
+        _target ## _ENUM(ENUM_FK_END_, (_enum_name, _target, _suffix)) \
+    }; \
+    int t = _target ## _get_index(target); \
+    if (t < 0) { \
+        *members = NULL; \
+        return 0; \
+    } \
+    *members = members_ + ends_[t]; \
+    return (size_t)(ends_[t + 1] - ends_[t]); \
+}
+
+/*-----------------------------------------------------------------------------
+ * Flag Enums
+ * Power-of-two members combined into bit masks
+ *-----------------------------------------------------------------------------*/
+
+/* Flag Generators
+ * ---------------
+ * ENUM_FLAG_ASSIGN_: Assigns a member the bit of its dense index. Passed as
+ *       the X argument of a list, with the enum name as G.
+ *       Example expansion: PERM_WRITE = 1 << PERM_idx_PERM_WRITE,
+ */
+#define ENUM_FLAG_ASSIGN_(_name, _1, ...) _1 = 1 << _name ## _idx_ ## _1,
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ENUMS_CTZ_(_x) __builtin_ctz(_x)
+#else
+static inline int enumfactory_ctz_(unsigned x) {
+    int n = 0;
+    while (!(x & 1u)) { x >>= 1; n++; }
+    return n;
+}
+#define ENUMS_CTZ_(_x) enumfactory_ctz_(_x)
+#endif
+
+/* Appends n bytes of text at offset *len of a buffer of the given size,
+ * truncating (but always counting) what does not fit, snprintf-style. */
+static inline void enumfactory_append_(char* buf, size_t size, size_t* len,
+                                       const char* text, size_t n) {
+    if (*len + 1 < size) {
+        size_t room = size - 1 - *len;
+        memcpy(buf + *len, text, n < room ? n : room);
+    }
+    *len += n;
+}
+
+/* Parses a decimal or 0x-prefixed hexadecimal token of exactly n bytes.
+ * Returns 1 on success, 0 if the token is empty, malformed or overflows. */
+static inline int enumfactory_parse_uint_(const char* text, size_t n, unsigned* out) {
+    unsigned base = 10, value = 0;
+    size_t i = 0;
+    if (n > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        i = 2;
+    }
+    if (i == n) return 0;
+    for (; i < n; i++) {
+        char c = text[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = (unsigned)(c - '0');
+        else if (base == 16 && c >= 'a' && c <= 'f') digit = (unsigned)(c - 'a' + 10);
+        else if (base == 16 && c >= 'A' && c <= 'F') digit = (unsigned)(c - 'A' + 10);
+        else return 0;
+        if (digit >= base || value > (~0u - digit) / base) return 0;
+        value = value * base + digit;
+    }
+    *out = value;
+    return 1;
+}
+
+/* ENUMS_FLAGS:
+ * Generates a flag enum from NAME_ENUM: member i gets the value 1 << i, in
+ * list order (at most 31 members). Extra data columns are ignored. Besides
+ * the usual core artifacts (_count, _get_label, dense indices) it generates:
+ *
+ * - NAME_all: the mask of every defined bit.
+ * - NAME_is_valid_mask(mask): 1 if mask has no unknown bits.
+ * - NAME_format(mask, buf, size): writes "READ|WRITE" into buf, one label
+ *   per set bit in bit order, and returns the full length like snprintf
+ *   (the output is truncated but always NUL-terminated when size > 0).
+ *   Unknown bits are appended as one hexadecimal term ("READ|0x40") and an
+ *   empty mask formats as "0", so every mask round-trips through parse.
+ * - NAME_parse(text, len, &mask): parses '|'-separated labels and numeric
+ *   terms (surrounding spaces allowed) without allocating. Returns 1 on
+ *   success, 0 on an empty or unknown term, leaving mask untouched.
+ *
+ * Label lookup in NAME_get_label still works on single flags only.
+ */
+#define ENUMS_FLAGS(_enum_name) \
+GENERATE_ENUM_INDEX_(_enum_name, _enum_name ## _ENUM) \
+ENUMS_STATIC_ASSERT_(_enum_name ## _idx_total <= 31, \
+                     "ENUMS_FLAGS: " #_enum_name " has more than 31 flags"); \
+typedef enum { \
+    _enum_name ## _ENUM(ENUM_FLAG_ASSIGN_, _enum_name) \
+    _enum_name ## _total \
+} _enum_name; \
+GENERATE_ENUM_ACCESSORS_(_enum_name, _enum_name ## _ENUM) \
+enum { _enum_name ## _all = (int)((1u << _enum_name ## _idx_total) - 1u) }; \
+static inline int _enum_name ## _is_valid_mask(unsigned mask) { \
+    return (mask & ~(unsigned)_enum_name ## _all) == 0; \
+} \
+static inline size_t _enum_name ## _format(unsigned mask, char* buf, size_t size) { \
+    static const char* const labels_[] = { _enum_name ## _ENUM(X_COMMA_, ENUM_LABEL_) NULL }; \
+    static const size_t lens_[] = { _enum_name ## _ENUM(X_COMMA_, ENUM_LABEL_LEN_) 0 }; \
+    unsigned known = mask & (unsigned)_enum_name ## _all; \
+    unsigned unknown = mask & ~(unsigned)_enum_name ## _all; \
+    size_t len = 0; \
+    while (known) { \
+        int bit = ENUMS_CTZ_(known); \
+        known &= known - 1; \
+        if (len) enumfactory_append_(buf, size, &len, "|", 1); \
+        enumfactory_append_(buf, size, &len, labels_[bit], lens_[bit]); \
+    } \
+    if (unknown || !mask) { \
+        char hex[12]; \
+        size_t n = sizeof(hex); \
+        do { \
+            hex[--n] = "0123456789abcdef"[unknown & 0xfu]; \
+            unknown >>= 4; \
+        } while (unknown); \
+        if (mask) { \
+            hex[--n] = 'x'; \
+            hex[--n] = '0'; \
+        } \
+        if (len) enumfactory_append_(buf, size, &len, "|", 1); \
+        enumfactory_append_(buf, size, &len, hex + n, sizeof(hex) - n); \
+    } \
+    if (size) buf[len < size ? len : size - 1] = '\0'; \
+    return len; \
+} \
+static inline int _enum_name ## _parse(const char* text, size_t len, unsigned* mask) { \
+    static const char* const labels_[] = { _enum_name ## _ENUM(X_COMMA_, ENUM_LABEL_) NULL }; \
+    static const size_t lens_[] = { _enum_name ## _ENUM(X_COMMA_, ENUM_LABEL_LEN_) 0 }; \
+    unsigned result = 0; \
+    size_t pos = 0; \
+    for (;;) { \
+        size_t end = pos; \
+        while (end < len && text[end] != '|') end++; \
+        size_t start = pos, stop = end; \
+        while (start < stop && text[start] == ' ') start++; \
+        while (stop > start && text[stop - 1] == ' ') stop--; \
+        size_t n = stop - start; \
+        unsigned term; \
+        int k = 0; \
+        for (; k < _enum_name ## _idx_total; k++) { \
+            if (lens_[k] == n && memcmp(labels_[k], text + start, n) == 0) break; \
+        } \
+        if (k < _enum_name ## _idx_total) result |= 1u << k; \
+        else if (enumfactory_parse_uint_(text + start, n, &term)) result |= term; \
+        else return 0; \
+        if (end == len) break; \
+        pos = end + 1; \
+    } \
+    *mask = result; \
+    return 1; \
+}
+
+/*-----------------------------------------------------------------------------
+ * Range Classification
+ * Maps a measured number to the bucket whose threshold column covers it
+ *-----------------------------------------------------------------------------*/
+
+/* Classifier Generators
+ * ---------------------
+ * Both are passed as the X argument of a list, with the column index as G.
+ *
+ * ENUM_CLASSIFY_ASCENDING_: Emits one link of a chained comparison. Wrapped
+ *       in ENUM_CLASSIFY_ASCENDING_BEGIN_/_END_, a list of bounds b0, b1, b2
+ *       becomes ((1 || (b0)) && ((b0) < (b1)) && ((b1) < (b2)) && ((b2) < 0 || 1)),
+ *       which is a constant expression that holds only if the bounds are
+ *       strictly ascending.
+ *
+ * ENUM_CLASSIFY_ABOVE_: Emits "+ (value > bound)" for one member, so that the
+ *       sum over the list is the number of bounds below value.
+ */
+#define ENUM_CLASSIFY_ASCENDING_(_index, ...) \
+    (ENUM_COLUMN_(_index, __VA_ARGS__))) && ((ENUM_COLUMN_(_index, __VA_ARGS__)) <
+#define ENUM_CLASSIFY_ASCENDING_BEGIN_ ((1 ||
+#define ENUM_CLASSIFY_ASCENDING_END_ 0 || 1))
+#define ENUM_CLASSIFY_ABOVE_(_index, ...) + (value > ENUM_COLUMN_(_index, __VA_ARGS__))
+
+/* ENUMS_CLASSIFY:
+ * Generates NAME_classify(type value), which returns the first member (in
+ * list order) whose threshold is >= value, or NAME_total if value is above
+ * every threshold. Thresholds are inclusive upper bounds read from column
+ * INDEX (0-10, defaults to 0) and must be listed in strictly ascending
+ * order; this is checked with a static assertion. Floating-point bounds
+ * are not an integer constant expression in C, so for them the check
+ * relies on GCC/Clang constant folding (-Wpedantic warns about it);
+ * C++ accepts them as they are.
+ *
+ * The classifier is branchless: it counts the thresholds below value with
+ * one comparison per member and maps that count back through
+ * NAME_get_value. A NaN compares below every bound and lands in the first
+ * bucket.
+ *
+ * Also generates NAME_classify_batch(vals, n, out), which classifies an
+ * array into an int array (suitable for NAME_histogram).
+ */
+#define ENUMS_CLASSIFY_IMPL_(_enum_name, _enum_list, _type, _index) \
+ENUMS_STATIC_ASSERT_(ENUM_CLASSIFY_ASCENDING_BEGIN_ \
+                     _enum_list(ENUM_CLASSIFY_ASCENDING_, _index) \
+                     ENUM_CLASSIFY_ASCENDING_END_, \
+                     "ENUMS_CLASSIFY: thresholds of " #_enum_name " must be strictly ascending"); \
+static inline _enum_name _enum_name ## _classify(_type value) { \
+    int above = 0 _enum_list(ENUM_CLASSIFY_ABOVE_, _index); \
+    return (_enum_name)_enum_name ## _get_value(above); \
+} \
+static inline void _enum_name ## _classify_batch(const _type* vals, size_t n, int* out) { \
+    for (size_t i = 0; i < n; i++) { \
+        out[i] = (int)_enum_name ## _classify(vals[i]); \
+    } \
+}
+
+#define ENUMS_CLASSIFY_3_(enum_name, enum_list, type) \
+    ENUMS_CLASSIFY_IMPL_(enum_name, enum_list, type, 0)
+
+#define ENUMS_CLASSIFY_4_(enum_name, enum_list, type, index) \
+    ENUMS_CLASSIFY_IMPL_(enum_name, enum_list, type, index)
+
+#define ENUMS_CLASSIFY_GET_MACRO_(_1, _2, _3, _4, NAME, ...) NAME
+
+/* ENUMS_CLASSIFY accepts either 3 args (defaults to index 0) or 4 args (explicit index) */
+#define ENUMS_CLASSIFY(...) \
+    ENUMS_CLASSIFY_GET_MACRO_(__VA_ARGS__, ENUMS_CLASSIFY_4_, ENUMS_CLASSIFY_3_)(__VA_ARGS__)
+
+/*-----------------------------------------------------------------------------
+ * Bulk Counting
+ * Histograms over large arrays of raw enum values
+ *-----------------------------------------------------------------------------*/
+
+/* ENUMS_HISTOGRAM:
+ * Generates NAME_histogram(vals, n, counts, invalid), which counts how often
+ * each member occurs in vals. counts has NAME_idx_total entries and is
+ * indexed by dense index (NAME_get_index); it is overwritten, not accumulated.
+ * Values that are not members are tallied into *invalid (may be NULL).
+ *
+ * Values are mapped through a table of NAME_total slots built from the list
+ * at compile time, so member values must be non-negative (a negative value
+ * is a build error) and NAME_total should stay reasonably small.
+ *
+ * The loop is unrolled over ENUMS_HISTOGRAM_LANES_ private sub-histograms
+ * so that runs of the same value do not serialize on a single counter.
+ */
+#define ENUMS_HISTOGRAM_LANES_ 4
+
+#define ENUMS_HISTOGRAM_SLOT_(_enum_name, _slots, _v) \
+    ((unsigned)(_v) < (unsigned)_enum_name ## _total ? _slots[(unsigned)(_v)] : 0)
+
+#define ENUMS_HISTOGRAM(_enum_name, _enum_list) \
+static inline void _enum_name ## _histogram(const int* vals, size_t n, \
+                                            uint64_t counts[], size_t* invalid) { \
+    static const unsigned short slots_[_enum_name ## _total] = { \
+        _enum_list(ENUM_DENSE_SLOT_, _enum_name) \
+    }; \
+    uint64_t sub_[ENUMS_HISTOGRAM_LANES_][_enum_name ## _idx_total + 1] = {{0}}; \
+    size_t i = 0; \
+    for (; i + ENUMS_HISTOGRAM_LANES_ <= n; i += ENUMS_HISTOGRAM_LANES_) { \
+        sub_[0][ENUMS_HISTOGRAM_SLOT_(_enum_name, slots_, vals[i])]++; \
+        sub_[1][ENUMS_HISTOGRAM_SLOT_(_enum_name, slots_, vals[i + 1])]++; \
+        sub_[2][ENUMS_HISTOGRAM_SLOT_(_enum_name, slots_, vals[i + 2])]++; \
+        sub_[3][ENUMS_HISTOGRAM_SLOT_(_enum_name, slots_, vals[i + 3])]++; \
+    } \
+    for (; i < n; i++) { \
+        sub_[0][ENUMS_HISTOGRAM_SLOT_(_enum_name, slots_, vals[i])]++; \
+    } \
+    for (int k = 0; k < _enum_name ## _idx_total; k++) { \
+        counts[k] = sub_[0][k + 1] + sub_[1][k + 1] + sub_[2][k + 1] + sub_[3][k + 1]; \
+    } \
+    if (invalid) { \
+        *invalid = (size_t)(sub_[0][0] + sub_[1][0] + sub_[2][0] + sub_[3][0]); \
+    } \
+}
+
+#ifdef ENUMFACTORY_THREADS
+/* ENUMS_HISTOGRAM_MT:
+ * Generates NAME_histogram_mt(vals, n, counts, invalid, nthreads), which
+ * splits vals into nthreads contiguous slices, runs NAME_histogram on each
+ * (the calling thread takes the first slice) and merges the results.
+ * Requires ENUMS_HISTOGRAM(NAME, LIST) to be generated first, and
+ * ENUMFACTORY_THREADS to be defined before including this header.
+ *
+ * nthreads is clamped to 1 .. ENUMS_HISTOGRAM_MAX_THREADS_. If a thread
+ * cannot be created its slice is counted on the calling thread instead.
+ * The first slice is counted straight into counts; each extra thread gets
+ * a row of NAME_idx_total counters on the caller's stack, so stack use
+ * grows with nthreads rather than with ENUMS_HISTOGRAM_MAX_THREADS_.
+ */
+#define ENUMS_HISTOGRAM_MAX_THREADS_ 64
+
+#define ENUMS_HISTOGRAM_MT(_enum_name) \
+typedef struct { \
+    const int* vals; \
+    size_t n; \
+    size_t invalid; \
+    uint64_t* counts; \
+} _enum_name ## _histogram_task_; \
+static inline void* _enum_name ## _histogram_worker_(void* arg) { \
+    _enum_name ## _histogram_task_* task = (_enum_name ## _histogram_task_*)arg; \
+    _enum_name ## _histogram(task->vals, task->n, task->counts, &task->invalid); \
+    return NULL; \
+} \
+static inline void _enum_name ## _histogram_mt(const int* vals, size_t n, uint64_t counts[], \
+                                               size_t* invalid, int nthreads) { \
+    if (nthreads < 1) nthreads = 1; \
+    if (nthreads > ENUMS_HISTOGRAM_MAX_THREADS_) nthreads = ENUMS_HISTOGRAM_MAX_THREADS_; \
+    if ((size_t)nthreads > n) nthreads = (int)n; \
+    if (nthreads <= 1) { \
+        _enum_name ## _histogram(vals, n, counts, invalid); \
+        return; \
+    } \
+    _enum_name ## _histogram_task_ tasks[ENUMS_HISTOGRAM_MAX_THREADS_]; \
+    pthread_t threads[ENUMS_HISTOGRAM_MAX_THREADS_]; \
+    int started[ENUMS_HISTOGRAM_MAX_THREADS_]; \
+    uint64_t partial[nthreads - 1][_enum_name ## _idx_total]; \
+    size_t chunk = n / (size_t)nthreads; \
+    for (int t = 0; t < nthreads; t++) { \
+        tasks[t].vals = vals + (size_t)t * chunk; \
+        tasks[t].n = (t == nthreads - 1) ? n - (size_t)t * chunk : chunk; \
+        tasks[t].counts = t > 0 ? partial[t - 1] : counts; \
+        started[t] = t > 0 && pthread_create(&threads[t], NULL, \
+            _enum_name ## _histogram_worker_, &tasks[t]) == 0; \
+    } \
+    for (int t = 0; t < nthreads; t++) { \
+        if (!started[t]) _enum_name ## _histogram_worker_(&tasks[t]); \
+    } \
+    size_t bad = tasks[0].invalid; \
+    for (int t = 1; t < nthreads; t++) { \
+        if (started[t]) pthread_join(threads[t], NULL); \
+        for (int k = 0; k < _enum_name ## _idx_total; k++) counts[k] += partial[t - 1][k]; \
+        bad += tasks[t].invalid; \
+    } \
+    if (invalid) *invalid = bad; \
+}
+#endif /* ENUMFACTORY_THREADS */
+
+/*-----------------------------------------------------------------------------
+ * Registry
+ * Descriptors for generic, name-driven access to any generated enum
+ *-----------------------------------------------------------------------------*/
+
+/* Column kinds a descriptor can expose; each matches one accessor type. */
+typedef enum {
+    ENUMFACTORY_COLUMN_int,
+    ENUMFACTORY_COLUMN_float,
+    ENUMFACTORY_COLUMN_double,
+    ENUMFACTORY_COLUMN_string
+} enumfactory_column_kind;
+
+typedef struct {
+    const char* name;
+    enumfactory_column_kind kind;
+    union {
+        int (*as_int)(int value);
+        float (*as_float)(int value);
+        double (*as_double)(int value);
+        const char* (*as_string)(int value);
+    } get;
+} enumfactory_column;
+
+/* Everything generic code needs to handle an enum it does not know:
+ * values and labels are dense-index tables of count entries. */
+typedef struct {
+    const char* name;
+    size_t name_len;
+    int count;
+    int total;
+    const int* values;
+    const char* const* labels;
+    const size_t* label_lens;
+    int (*get_index)(int value);
+    const enumfactory_column* columns;
+    int column_count;
+} enumfactory_descriptor;
+
+typedef const enumfactory_descriptor* (*enumfactory_descriptor_fn)(void);
+
+/* Label of a value through a descriptor, or NULL if invalid. */
+static inline const char* enumfactory_label(const enumfactory_descriptor* desc, int value) {
+    int index = desc->get_index(value);
+    return index < 0 ? NULL : desc->labels[index];
+}
+
+/* Value of a label of exactly len bytes through a descriptor.
+ * Returns 1 and stores the value on success, 0 if no member has that label. */
+static inline int enumfactory_value(const enumfactory_descriptor* desc,
+                                    const char* label, size_t len, int* value) {
+    for (int i = 0; i < desc->count; i++) {
+        if (desc->label_lens[i] == len && memcmp(desc->labels[i], label, len) == 0) {
+            *value = desc->values[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Column of a descriptor by name, or NULL if it has no such column. */
+static inline const enumfactory_column* enumfactory_column_find(const enumfactory_descriptor* desc,
+                                                               const char* name) {
+    for (int i = 0; i < desc->column_count; i++) {
+        if (strcmp(desc->columns[i].name, name) == 0) return &desc->columns[i];
+    }
+    return NULL;
+}
+
+static inline uint32_t enumfactory_hash_(const char* text, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)text[i]) * 16777619u;
+    return h;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ENUMS_HAVE_ATOMICS_ 1
+#define ENUMS_ATOMIC_LOAD_(_p) __atomic_load_n(_p, __ATOMIC_ACQUIRE)
+#define ENUMS_ATOMIC_STORE_(_p, _v) __atomic_store_n(_p, _v, __ATOMIC_RELEASE)
+#define ENUMS_ATOMIC_CLAIM_(_p) enumfactory_atomic_claim_(_p)
+#define ENUMS_ATOMIC_NEXT_(_p) __atomic_fetch_add(_p, 1, __ATOMIC_RELAXED)
+#if defined(__x86_64__) || defined(__i386__)
+#define ENUMS_ATOMIC_PAUSE_() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define ENUMS_ATOMIC_PAUSE_() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define ENUMS_ATOMIC_PAUSE_() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/* Moves a lazy-build state from 0 (unbuilt) to 1 (building). Only the
+ * caller that performs the transition owns the build; a state that is
+ * already 1 or 2 is left untouched. */
+static inline int enumfactory_atomic_claim_(int* state) {
+    int expected = 0;
+    return __atomic_compare_exchange_n(state, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#else
+/* Without compiler atomics nothing is ever claimed, so lazily built indexes
+ * stay unbuilt and their lookups keep scanning. */
+#define ENUMS_HAVE_ATOMICS_ 0
+#define ENUMS_ATOMIC_LOAD_(_p) (*(_p))
+#define ENUMS_ATOMIC_STORE_(_p, _v) ((void)0)
+#define ENUMS_ATOMIC_CLAIM_(_p) 0
+#define ENUMS_ATOMIC_NEXT_(_p) ((*(_p))++)
+#endif
+
+/* Thread-local storage class for the header's per-thread state. */
+#if defined(__cplusplus)
+#define ENUMS_THREAD_LOCAL_ thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define ENUMS_THREAD_LOCAL_ _Thread_local
+#elif defined(_MSC_VER)
+#define ENUMS_THREAD_LOCAL_ __declspec(thread)
+#else
+#define ENUMS_THREAD_LOCAL_ __thread
+#endif
+
+/* Compile-time check that works in both C11 and C++11. */
+#if defined(__cplusplus)
+#define ENUMS_STATIC_ASSERT_(_cond, _msg) static_assert(_cond, _msg)
+#else
+#define ENUMS_STATIC_ASSERT_(_cond, _msg) _Static_assert(_cond, _msg)
+#endif
+
+/* Finds the id of a descriptor by name among n registry entries. slots
+ * (nslots > n, zero-initialized) is an open-addressing index of id + 1,
+ * built by the first caller; concurrent callers scan linearly until it is
+ * published. */
+static inline int enumfactory_registry_find_(const enumfactory_descriptor_fn* getters, int n,
+                                             unsigned short* slots, size_t nslots, int* state,
+                                             const char* name, size_t len) {
+    if (ENUMS_ATOMIC_LOAD_(state) != 2) {
+        if (ENUMS_ATOMIC_LOAD_(state) == 0 && ENUMS_ATOMIC_CLAIM_(state)) {
+            for (int i = 0; i < n; i++) {
+                const enumfactory_descriptor* d = getters[i]();
+                size_t s = enumfactory_hash_(d->name, d->name_len) % nslots;
+                while (slots[s]) s = (s + 1) % nslots;
+                slots[s] = (unsigned short)(i + 1);
+            }
+            ENUMS_ATOMIC_STORE_(state, 2);
+        } else {
+            for (int i = 0; i < n; i++) {
+                const enumfactory_descriptor* d = getters[i]();
+                if (d->name_len == len && memcmp(d->name, name, len) == 0) return i;
+            }
+            return -1;
+        }
+    }
+    for (size_t s = enumfactory_hash_(name, len) % nslots; slots[s]; s = (s + 1) % nslots) {
+        const enumfactory_descriptor* d = getters[slots[s] - 1]();
+        if (d->name_len == len && memcmp(d->name, name, len) == 0) return slots[s] - 1;
+    }
+    return -1;
+}
+
+/* Descriptor Generators
+ * ---------------------
+ * ENUM_COLUMN_ENTRY_: Describes one accessor generated by ENUMS_ARRAY.
+ *       Passed as X over a column list X(G, SUFFIX, KIND), with the enum name
+ *       as G. KIND is int, float, double or string.
+ *       Example expansion:
+ *           { "price", ENUMFACTORY_COLUMN_float, { .as_float = STOCK_get_price } },
+ *
+ * ENUM_REGISTRY_ENTRY_: Descriptor of one enum in a registry list.
+ *       Example expansion: STOCK_get_descriptor,
+ */
+#define ENUM_COLUMN_ENTRY_(_name, _suffix, _kind) \
+    { #_suffix, ENUMFACTORY_COLUMN_ ## _kind, { .as_ ## _kind = _name ## _get_ ## _suffix } },
+#define ENUM_REGISTRY_ENTRY_(_g, _1, ...) _1 ## _get_descriptor,
+#define ENUM_NO_COLUMNS_(X, G)
+
+/* ENUM_DESCRIPTOR:
+ * Opt-in registration step for an enum generated by any core macro.
+ * Generates NAME_get_descriptor(), returning a static descriptor with the
+ * name, _count, _total, dense value and label tables and, optionally, the
+ * column accessors listed in COLUMNS:
+ *
+ *     #define STOCK_COLUMNS(X, G) X(G, price, float) X(G, sector, string)
+ *     ENUM_DESCRIPTOR(STOCK, STOCK_ENUM, STOCK_COLUMNS);
+ */
+#define ENUM_DESCRIPTOR_IMPL_(_enum_name, _enum_list, _columns) \
+static inline const enumfactory_descriptor* _enum_name ## _get_descriptor(void) { \
+    static const int values_[] = { _enum_list(X_COMMA_, ENUM) 0 }; \
+    static const char* const labels_[] = { _enum_list(X_COMMA_, ENUM_LABEL_) NULL }; \
+    static const size_t label_lens_[] = { _enum_list(X_COMMA_, ENUM_LABEL_LEN_) 0 }; \
+    static const enumfactory_column columns_[] = { \
+        _columns(ENUM_COLUMN_ENTRY_, _enum_name) \
+        { NULL, ENUMFACTORY_COLUMN_int, { NULL } } \
+    }; \
+    static const enumfactory_descriptor desc_ = { \
+        #_enum_name, sizeof(#_enum_name) - 1, \
+        _enum_name ## _idx_total, (int)_enum_name ## _total, \
+        values_, labels_, label_lens_, _enum_name ## _get_index, \
+        columns_, (int)(sizeof(columns_) / sizeof(columns_[0])) - 1 \
+    }; \
+    return &desc_; \
+}
+
+#define ENUM_DESCRIPTOR_2_(enum_name, enum_list) \
+    ENUM_DESCRIPTOR_IMPL_(enum_name, enum_list, ENUM_NO_COLUMNS_)
+
+#define ENUM_DESCRIPTOR_3_(enum_name, enum_list, columns) \
+    ENUM_DESCRIPTOR_IMPL_(enum_name, enum_list, columns)
+
+#define ENUM_DESCRIPTOR_GET_MACRO_(_1, _2, _3, NAME, ...) NAME
+
+/* ENUM_DESCRIPTOR accepts either 2 args (no columns) or 3 args (column list) */
+#define ENUM_DESCRIPTOR(...) \
+    ENUM_DESCRIPTOR_GET_MACRO_(__VA_ARGS__, ENUM_DESCRIPTOR_3_, ENUM_DESCRIPTOR_2_)(__VA_ARGS__)
+
+/* ENUMS_REGISTRY:
+ * Collects the descriptors of the enums named in a registry list
+ * (X(G, NAME) per entry, each with an ENUM_DESCRIPTOR) into a static array.
+ * Entries get dense ids REGISTRY_idx_NAME, and the registry provides:
+ *
+ * - REGISTRY_get(id): descriptor by id, or NULL. O(1).
+ * - REGISTRY_find(name, len): descriptor by enum name, or NULL. O(1) through
+ *   a hash index built on first use.
+ * - REGISTRY_find_id(name, len): id by enum name, or -1.
+ */
+#define ENUMS_REGISTRY(_registry, _registry_list) \
+GENERATE_ENUM_INDEX_(_registry, _registry_list) \
+static const enumfactory_descriptor_fn _registry ## _getters_[_registry ## _idx_total + 1] = { \
+    _registry_list(ENUM_REGISTRY_ENTRY_, 0) NULL \
+}; \
+static inline const enumfactory_descriptor* _registry ## _get(int id) { \
+    return (id >= 0 && id < _registry ## _idx_total) ? _registry ## _getters_[id]() : NULL; \
+} \
+static inline int _registry ## _find_id(const char* name, size_t len) { \
+    static unsigned short slots_[_registry ## _idx_total * 2 + 1]; \
+    static int state_; \
+    return enumfactory_registry_find_(_registry ## _getters_, _registry ## _idx_total, \
+                                      slots_, sizeof(slots_) / sizeof(slots_[0]), &state_, \
+                                      name, len); \
+} \
+static inline const enumfactory_descriptor* _registry ## _find(const char* name, size_t len) { \
+    return _registry ## _get(_registry ## _find_id(name, len)); \
+}
+
+/*-----------------------------------------------------------------------------
+ * Weighted Sampling
+ * Draws members with probabilities taken from a weight column
+ *-----------------------------------------------------------------------------*/
+
+/* Seedable PRNG (splitmix64): one 64-bit word of state, so a seed fully
+ * determines the sequence of draws. */
+typedef struct {
+    uint64_t state;
+} enumfactory_rng;
+
+static inline void enumfactory_rng_seed(enumfactory_rng* rng, uint64_t seed) {
+    rng->state = seed;
+}
+
+static inline uint64_t enumfactory_rng_next(enumfactory_rng* rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* Per-thread generator used when a sampler is passed a NULL rng. On first
+ * use each thread seeds it from a shared counter and the address of its
+ * own state, so threads draw different sequences. Reseed it with
+ * enumfactory_rng_seed for reproducible draws. */
+static inline enumfactory_rng* enumfactory_rng_local(void) {
+    static ENUMS_THREAD_LOCAL_ enumfactory_rng rng;
+    static ENUMS_THREAD_LOCAL_ int seeded;
+    static uint64_t threads_;
+    if (!seeded) {
+        uint64_t n = ENUMS_ATOMIC_NEXT_(&threads_);
+        enumfactory_rng_seed(&rng, 0x853C49E6748FEA9Bull ^ (n * 0xD1B54A32D192ED03ull)
+                                   ^ (uint64_t)(uintptr_t)&rng);
+        seeded = 1;
+    }
+    return &rng;
+}
+
+/* Alias table: column i is accepted with probability prob[i] / 2^32 and
+ * otherwise yields alias[i]; both hold member values. */
+typedef struct {
+    const uint64_t* prob;
+    const int* accept;
+    const int* alias;
+    int n;
+} enumfactory_alias_table;
+
+/* Builds an alias table from n non-negative weights (Vose's method).
+ * scaled and work are scratch arrays of n entries. */
+static inline void enumfactory_alias_build_(const double* weights, const int* values, int n,
+                                            double* scaled, int* work,
+                                            uint64_t* prob, int* accept, int* alias) {
+    double sum = 0.0;
+    int small = 0, large = n;
+    for (int i = 0; i < n; i++) sum += weights[i];
+    for (int i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / sum;
+        accept[i] = values[i];
+        alias[i] = values[i];
+        if (scaled[i] < 1.0) work[small++] = i;
+        else work[--large] = i;
+    }
+    while (small > 0 && large < n) {
+        int s = work[--small];
+        int l = work[large++];
+        prob[s] = (uint64_t)(scaled[s] * 4294967296.0);
+        alias[s] = values[l];
+        scaled[l] += scaled[s] - 1.0;
+        if (scaled[l] < 1.0) work[small++] = l;
+        else work[--large] = l;
+    }
+    /* Leftovers are 1.0 up to rounding and always accept. */
+    while (small > 0) prob[work[--small]] = 4294967296ull;
+    while (large < n) prob[work[large++]] = 4294967296ull;
+}
+
+static inline int enumfactory_alias_draw_(const enumfactory_alias_table* table, uint64_t r) {
+    uint32_t column = (uint32_t)(((r >> 32) * (uint64_t)table->n) >> 32);
+    return (r & 0xFFFFFFFFull) < table->prob[column] ? table->accept[column] : table->alias[column];
+}
+
+/* Builds an alias table once per *state (0 unbuilt, 1 building, 2 built).
+ * The caller that claims the state builds it and concurrent first callers
+ * wait. Without compiler atomics the table is built without claiming or
+ * waiting, which is only safe if the first call happens before any other
+ * thread samples. */
+static inline void enumfactory_alias_once_(int* state, const double* weights, const int* values,
+                                           int n, double* scaled, int* work,
+                                           uint64_t* prob, int* accept, int* alias) {
+#if ENUMS_HAVE_ATOMICS_
+    if (ENUMS_ATOMIC_CLAIM_(state)) {
+        enumfactory_alias_build_(weights, values, n, scaled, work, prob, accept, alias);
+        ENUMS_ATOMIC_STORE_(state, 2);
+    } else {
+        while (ENUMS_ATOMIC_LOAD_(state) != 2) ENUMS_ATOMIC_PAUSE_();
+    }
+#else
+    if (*state != 2) {
+        enumfactory_alias_build_(weights, values, n, scaled, work, prob, accept, alias);
+        *state = 2;
+    }
+#endif
+}
+
+/* Sampler Generators
+ * ------------------
+ * Passed as the X argument of a list, with the weight column index as G.
+ *
+ * ENUM_SAMPLER_WEIGHT_: The weight of a member as a double initializer.
+ *       Example expansion (index 10): (double)(55000000),
+ *
+ * ENUM_SAMPLER_NONNEG_ / ENUM_SAMPLER_POSITIVE_: Terms of the compile-time
+ *       checks that every weight is >= 0 and that at least one is > 0.
+ *       Comparisons rather than a sum, so large weights cannot overflow.
+ *       Example expansion: && ((55000000) >= 0) / || ((55000000) > 0)
+ */
+#define ENUM_SAMPLER_WEIGHT_(_index, _1, ...) (double)(ENUM_COLUMN_(_index, _1, __VA_ARGS__)),
+#define ENUM_SAMPLER_NONNEG_(_index, _1, ...) && ((ENUM_COLUMN_(_index, _1, __VA_ARGS__)) >= 0)
+#define ENUM_SAMPLER_POSITIVE_(_index, _1, ...) || ((ENUM_COLUMN_(_index, _1, __VA_ARGS__)) > 0)
+
+/* ENUMS_SAMPLER:
+ * Generates a weighted random sampler over the members of NAME, using column
+ * INDEX (0-10) of LIST as weights. The weights are checked at compile time
+ * and turned into an alias table on first use (concurrent first callers
+ * wait for the build; see enumfactory_alias_once_ for compilers without
+ * atomics). Generates:
+ *
+ * - NAME_sampler_table(): the alias table.
+ * - NAME_sample(rng): one member value in O(1), from one 64-bit draw.
+ * - NAME_sample_batch(rng, out, n): n draws into out.
+ *
+ * rng may be NULL to use the calling thread's enumfactory_rng_local().
+ */
+#define ENUMS_SAMPLER(_enum_name, _enum_list, _index) \
+ENUMS_STATIC_ASSERT_(1 _enum_list(ENUM_SAMPLER_NONNEG_, _index), \
+                     "ENUMS_SAMPLER: weights of " #_enum_name " must be non-negative"); \
+ENUMS_STATIC_ASSERT_(0 _enum_list(ENUM_SAMPLER_POSITIVE_, _index), \
+                     "ENUMS_SAMPLER: weights of " #_enum_name " must not all be zero"); \
+static inline const enumfactory_alias_table* _enum_name ## _sampler_table(void) { \
+    static uint64_t prob_[_enum_name ## _idx_total]; \
+    static int accept_[_enum_name ## _idx_total]; \
+    static int alias_[_enum_name ## _idx_total]; \
+    static const enumfactory_alias_table table_ = { prob_, accept_, alias_, _enum_name ## _idx_total }; \
+    static int state_; \
+    if (ENUMS_ATOMIC_LOAD_(&state_) != 2) { \
+        static const double weights_[] = { _enum_list(ENUM_SAMPLER_WEIGHT_, _index) 0 }; \
+        static const int values_[] = { _enum_list(X_COMMA_, ENUM) 0 }; \
+        double scaled[_enum_name ## _idx_total]; \
+        int work[_enum_name ## _idx_total]; \
+        enumfactory_alias_once_(&state_, weights_, values_, _enum_name ## _idx_total, \
+                                scaled, work, prob_, accept_, alias_); \
+    } \
+    return &table_; \
+} \
+static inline int _enum_name ## _sample(enumfactory_rng* rng) { \
+    if (!rng) rng = enumfactory_rng_local(); \
+    return enumfactory_alias_draw_(_enum_name ## _sampler_table(), enumfactory_rng_next(rng)); \
+} \
+static inline void _enum_name ## _sample_batch(enumfactory_rng* rng, int* out, size_t n) { \
+    const enumfactory_alias_table* table = _enum_name ## _sampler_table(); \
+    if (!rng) rng = enumfactory_rng_local(); \
+    for (size_t i = 0; i < n; i++) { \
+        out[i] = enumfactory_alias_draw_(table, enumfactory_rng_next(rng)); \
+    } \
+}
+
+/*-----------------------------------------------------------------------------
+ * Streaming Aggregation
+ * Per-member event counts over sliding time windows
+ *-----------------------------------------------------------------------------*/
+
+#define ENUMS_STREAM_MAX_WINDOWS_ 4
+
+/* ENUMS_STREAM:
+ * Generates NAME_stream, an aggregator for endless (timestamp, value)
+ * events. Time is cut into buckets of bucket_width timestamp units, and the
+ * last BUCKETS buckets are kept in a ring of per-member counters (by dense
+ * index). Each window keeps running totals over its newest buckets.
+ *
+ * - NAME_stream_init(s, bucket_width, windows, window_count): configures up
+ *   to ENUMS_STREAM_MAX_WINDOWS_ windows, each 1 to BUCKETS buckets wide.
+ *   Returns 0, or -1 for an invalid configuration.
+ * - NAME_stream_add(s, ts, value): O(windows) per event, one ring counter
+ *   plus one running total per window. Late events still inside the ring
+ *   are credited to their bucket; older ones are counted in s->late, and
+ *   non-members in s->invalid. NAME_stream_add_batch takes arrays.
+ * - NAME_stream_advance(s, now): moves time forward without an event.
+ *   Starting a bucket retires the buckets that leave each window.
+ * - NAME_stream_snapshot(s, window, counts): copies a window's totals (by
+ *   dense index) into counts.
+ * - NAME_stream_rate(s, window, value): events per timestamp unit.
+ * - NAME_stream_top(s, window, k, labels, values, counts): the up to k
+ *   members with the highest rate, highest first, skipping members without
+ *   events; values and counts may be NULL. Returns how many were written.
+ *
+ * The queries take a window position 0 .. window_count - 1 as passed to
+ * NAME_stream_init. For any other window, snapshot zeroes counts, rate
+ * returns 0.0 and top returns 0.
+ *
+ * None of these allocate. The struct holds BUCKETS * NAME_count 64-bit
+ * counters; declare it static or on the heap for large enums. BUCKETS must
+ * be at least 1 (checked at compile time).
+ */
+#define ENUMS_STREAM(_enum_name, _buckets) \
+ENUMS_STATIC_ASSERT_((_buckets) >= 1, \
+                     "ENUMS_STREAM: " #_enum_name " needs at least one bucket"); \
+typedef struct { \
+    uint64_t bucket_width; \
+    uint64_t head; \
+    int started; \
+    int window_count; \
+    uint32_t windows[ENUMS_STREAM_MAX_WINDOWS_]; \
+    uint64_t totals[ENUMS_STREAM_MAX_WINDOWS_][_enum_name ## _idx_total + 1]; \
+    uint64_t ring[_buckets][_enum_name ## _idx_total + 1]; \
+    uint64_t invalid; \
+    uint64_t late; \
+} _enum_name ## _stream; \
+static inline int _enum_name ## _stream_init(_enum_name ## _stream* s, uint64_t bucket_width, \
+                                             const unsigned* windows, int window_count) { \
+    if (bucket_width == 0 || window_count < 1 || window_count > ENUMS_STREAM_MAX_WINDOWS_) return -1; \
+    for (int w = 0; w < window_count; w++) { \
+        if (windows[w] < 1 || windows[w] > (_buckets)) return -1; \
+    } \
+    memset(s, 0, sizeof(*s)); \
+    s->bucket_width = bucket_width; \
+    s->window_count = window_count; \
+    for (int w = 0; w < window_count; w++) s->windows[w] = windows[w]; \
+    return 0; \
+} \
+static inline void _enum_name ## _stream_advance(_enum_name ## _stream* s, uint64_t now) { \
+    uint64_t bucket = now / s->bucket_width; \
+    if (!s->started) { \
+        s->started = 1; \
+        s->head = bucket; \
+        return; \
+    } \
+    if (bucket <= s->head) return; \
+    if (bucket - s->head >= (_buckets)) { \
+        memset(s->totals, 0, sizeof(s->totals)); \
+        memset(s->ring, 0, sizeof(s->ring)); \
+        s->head = bucket; \
+        return; \
+    } \
+    while (s->head < bucket) { \
+        uint64_t next = ++s->head; \
+        for (int w = 0; w < s->window_count; w++) { \
+            const uint64_t* leaving = s->ring[(next + (_buckets) - s->windows[w]) % (_buckets)]; \
+            for (int k = 0; k < _enum_name ## _idx_total; k++) s->totals[w][k] -= leaving[k]; \
+        } \
+        memset(s->ring[next % (_buckets)], 0, sizeof(s->ring[0])); \
+    } \
+} \
+static inline void _enum_name ## _stream_add(_enum_name ## _stream* s, uint64_t ts, int value) { \
+    int index = _enum_name ## _get_index(value); \
+    if (index < 0) { \
+        s->invalid++; \
+        return; \
+    } \
+    _enum_name ## _stream_advance(s, ts); \
+    uint64_t age = s->head - ts / s->bucket_width; \
+    if (age >= (_buckets)) { \
+        s->late++; \
+        return; \
+    } \
+    s->ring[(s->head - age) % (_buckets)][index]++; \
+    for (int w = 0; w < s->window_count; w++) { \
+        if (age < s->windows[w]) s->totals[w][index]++; \
+    } \
+} \
+static inline void _enum_name ## _stream_add_batch(_enum_name ## _stream* s, const uint64_t* ts, \
+                                                   const int* values, size_t n) { \
+    for (size_t i = 0; i < n; i++) _enum_name ## _stream_add(s, ts[i], values[i]); \
+} \
+static inline void _enum_name ## _stream_snapshot(const _enum_name ## _stream* s, int window, \
+                                                  uint64_t counts[]) { \
+    if (window < 0 || window >= s->window_count) { \
+        memset(counts, 0, sizeof(uint64_t) * _enum_name ## _idx_total); \
+        return; \
+    } \
+    memcpy(counts, s->totals[window], sizeof(uint64_t) * _enum_name ## _idx_total); \
+} \
+static inline double _enum_name ## _stream_rate(const _enum_name ## _stream* s, int window, int value) { \
+    int index = _enum_name ## _get_index(value); \
+    if (index < 0 || window < 0 || window >= s->window_count) return 0.0; \
+    return (double)s->totals[window][index] / ((double)s->windows[window] * (double)s->bucket_width); \
+} \
+static inline size_t _enum_name ## _stream_top(const _enum_name ## _stream* s, int window, size_t k, \
+                                               const char** labels, int* values, uint64_t* counts) { \
+    int top[_enum_name ## _idx_total + 1]; \
+    size_t found = 0; \
+    if (window < 0 || window >= s->window_count) return 0; \
+    const uint64_t* totals = s->totals[window]; \
+    if (k > (size_t)_enum_name ## _idx_total) k = (size_t)_enum_name ## _idx_total; \
+    if (k == 0) return 0; \
+    for (int i = 0; i < _enum_name ## _idx_total; i++) { \
+        if (!totals[i] || (found == k && totals[i] <= totals[top[k - 1]])) continue; \
+        size_t pos = found < k ? found++ : k - 1; \
+        while (pos > 0 && totals[top[pos - 1]] < totals[i]) { \
+            top[pos] = top[pos - 1]; \
+            pos--; \
+        } \
+        top[pos] = i; \
+    } \
+    for (size_t j = 0; j < found; j++) { \
+        int value = _enum_name ## _get_value(top[j]); \
+        labels[j] = _enum_name ## _get_label(value); \
+        if (values) values[j] = value; \
+        if (counts) counts[j] = totals[top[j]]; \
+    } \
+    return found; \
+}
+
 /*-----------------------------------------------------------------------------
  * Safety and Validation Macros
  * Provides runtime safety checks and bounds validation
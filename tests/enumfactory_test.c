@@ -7,8 +7,17 @@
  * 3. String label mapping
  * 4. Safety features
  * 5. Bounds checking
+ * 6. Dense indices and histograms
+ * 7. Range classification
+ * 8. Flag enums
+ * 9. Foreign-key columns
+ * 10. Enum registry and descriptors
+ * 11. Weighted sampling
+ * 12. Streaming window aggregation
  */
 
+#define ENUMFACTORY_THREADS
+
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -173,6 +182,183 @@ static inline const char* color_hex_get(int value) {
  * - ERROR (500) -> "Internal failure"
  */
 
+/* Histograms over raw STATUS values (sparse) and COLOR values (dense).
+ * Counts are indexed by dense index: OK=0, NOT_FOUND=1, ERROR=2.
+ */
+ENUMS_HISTOGRAM(STATUS, STATUS_ENUM);
+ENUMS_HISTOGRAM_MT(STATUS);
+ENUMS_HISTOGRAM(COLOR, COLOR_ENUM);
+
+/* Latency buckets: thresholds at index 0 are inclusive upper bounds in ms.
+ * SIZE_BUCKET reuses an assigned enum and reads float thresholds at index 1.
+ */
+#define LATENCY_ENUM(X, G) \
+    X(G, LAT_FAST, 10) \
+    X(G, LAT_OK, 100) \
+    X(G, LAT_SLOW, 1000)
+
+#define SIZE_BUCKET_ENUM(X, G) \
+    X(G, SIZE_TINY, 7, 0.5) \
+    X(G, SIZE_SMALL, 3, 64.0) \
+    X(G, SIZE_LARGE, 9, 4096.0)
+
+ENUMS_AUTOMATIC(LATENCY);
+ENUMS_CLASSIFY(LATENCY, LATENCY_ENUM, int);
+ENUMS_ASSIGNED(SIZE_BUCKET);
+ENUMS_CLASSIFY(SIZE_BUCKET, SIZE_BUCKET_ENUM, double, 1);
+/*
+ * Generated Enum: LATENCY
+ * -------------------------
+ * Type: Automatic + Classifier
+ * Actual Member Count: 3
+ * Range (total): 0 to 3 (exclusive)
+ *
+ * Buckets:
+ * - LAT_FAST = 0 (value <= 10)
+ * - LAT_OK   = 1 (value <= 100)
+ * - LAT_SLOW = 2 (value <= 1000)
+ * - LATENCY_total above 1000
+ *
+ * Generated Enum: SIZE_BUCKET
+ * -------------------------
+ * Type: Assigned + Classifier (index 1)
+ * Actual Member Count: 3
+ * Range (total): 0 to 10 (exclusive)
+ *
+ * Buckets:
+ * - SIZE_TINY  = 7 (value <= 0.5)
+ * - SIZE_SMALL = 3 (value <= 64.0)
+ * - SIZE_LARGE = 9 (value <= 4096.0)
+ * - SIZE_BUCKET_total above 4096.0
+ */
+
+/* Define a permission flag enum: values are assigned 1 << position */
+#define PERM_ENUM(X, G) \
+    X(G, PERM_READ) \
+    X(G, PERM_WRITE) \
+    X(G, PERM_EXEC) \
+    X(G, PERM_ADMIN)
+
+ENUMS_FLAGS(PERM);
+/*
+ * Generated Enum: PERM
+ * -------------------------
+ * Type: Flags
+ * Actual Member Count: 4
+ * Range (total): 0 to 9 (exclusive)
+ *
+ * Members & Values:
+ * - PERM_READ = 1 ("PERM_READ")
+ * - PERM_WRITE = 2 ("PERM_WRITE")
+ * - PERM_EXEC = 4 ("PERM_EXEC")
+ * - PERM_ADMIN = 8 ("PERM_ADMIN")
+ * - PERM_all = 15
+ */
+
+/* Define a sector enum referenced by the TICKER list below. The sector
+ * column (index 1) holds SECTOR members instead of free-form strings.
+ */
+#define SECTOR_ENUM(X, G) \
+    X(G, SECTOR_TECH, 10, "Technology") \
+    X(G, SECTOR_FIN, 20, "Financials") \
+    X(G, SECTOR_HEALTH, 30, "Healthcare") \
+    X(G, SECTOR_ENERGY, 40, "Energy")
+
+#define TICKER_ENUM(X, G) \
+    X(G, TK_AAPL, 1, SECTOR_TECH) \
+    X(G, TK_JPM, 2, SECTOR_FIN) \
+    X(G, TK_MSFT, 3, SECTOR_TECH) \
+    X(G, TK_LLY, 5, SECTOR_HEALTH) \
+    X(G, TK_NVDA, 8, SECTOR_TECH) \
+    X(G, TK_GS, 9, SECTOR_FIN)
+
+ENUMS_ASSIGNED(SECTOR);
+ENUMS_ARRAY(SECTOR, SECTOR_ENUM, const char*, name, 1);
+ENUMS_ASSIGNED(TICKER);
+ENUMS_FOREIGN_KEY(TICKER, TICKER_ENUM, SECTOR, sector, 1);
+/*
+ * Generated Enum: TICKER
+ * -------------------------
+ * Type: Assigned + Foreign Key (index 1 -> SECTOR)
+ * Actual Member Count: 6
+ * Range (total): 0 to 10 (exclusive)
+ *
+ * Mappings:
+ * - TK_AAPL = 1 -> SECTOR_TECH (10)
+ * - TK_JPM  = 2 -> SECTOR_FIN (20)
+ * - TK_MSFT = 3 -> SECTOR_TECH (10)
+ * - TK_LLY  = 5 -> SECTOR_HEALTH (30)
+ * - TK_NVDA = 8 -> SECTOR_TECH (10)
+ * - TK_GS   = 9 -> SECTOR_FIN (20)
+ *
+ * Reverse lists:
+ * - SECTOR_TECH -> TK_AAPL, TK_MSFT, TK_NVDA
+ * - SECTOR_FIN -> TK_JPM, TK_GS
+ * - SECTOR_HEALTH -> TK_LLY
+ * - SECTOR_ENERGY -> (none)
+ */
+
+/* Registry of descriptors for generic, name-driven access.
+ * PRIORITY exposes its PRIORITY_SCORE_GEN accessors as columns.
+ * Ids: REGISTRY_idx_COLOR=0, REGISTRY_idx_STATUS=1, REGISTRY_idx_PRIORITY=2,
+ *      REGISTRY_idx_PERM=3
+ */
+#define PRIORITY_COLUMNS(X, G) \
+    X(G, score, int) \
+    X(G, rate, float) \
+    X(G, word, string)
+
+ENUM_DESCRIPTOR(COLOR, COLOR_ENUM);
+ENUM_DESCRIPTOR(STATUS, STATUS_ENUM);
+ENUM_DESCRIPTOR(PRIORITY, PRIORITY_ENUM, PRIORITY_COLUMNS);
+ENUM_DESCRIPTOR(PERM, PERM_ENUM);
+
+#define REGISTRY_ENUM(X, G) \
+    X(G, COLOR) \
+    X(G, STATUS) \
+    X(G, PRIORITY) \
+    X(G, PERM)
+
+ENUMS_REGISTRY(REGISTRY, REGISTRY_ENUM);
+
+/* Weighted sampler over PRIORITY using the amount column (index 3) of
+ * PRIORITY_SCORE_GEN: LOW 3300, MEDIUM 2000, HIGH 1000 (total 6300).
+ * SHARD covers zero weights.
+ */
+ENUMS_SAMPLER(PRIORITY, PRIORITY_SCORE_GEN, 3);
+
+#define SHARD_ENUM(X, G) \
+    X(G, SHARD_A, 1) \
+    X(G, SHARD_B, 0) \
+    X(G, SHARD_C, 3)
+
+ENUMS_AUTOMATIC(SHARD);
+ENUMS_SAMPLER(SHARD, SHARD_ENUM, 0);
+/*
+ * Generated Enum: SHARD
+ * -------------------------
+ * Type: Automatic + Sampler (index 0)
+ * Actual Member Count: 3
+ * Range (total): 0 to 3 (exclusive)
+ *
+ * Weights:
+ * - SHARD_A = 0 (1 -> 25%)
+ * - SHARD_B = 1 (0 -> never drawn)
+ * - SHARD_C = 2 (3 -> 75%)
+ */
+
+/* Weights whose sum overflows int, as with volume columns; the table is
+ * first built by racing threads in test_sampler. */
+#define VOLUME_ENUM(X, G) \
+    X(G, VOLUME_BID, 1500000000) \
+    X(G, VOLUME_ASK, 1500000000)
+
+ENUMS_AUTOMATIC(VOLUME);
+ENUMS_SAMPLER(VOLUME, VOLUME_ENUM, 0);
+
+/* Streaming aggregation of STATUS events over a 64-bucket ring */
+ENUMS_STREAM(STATUS, 64);
+
 /*-----------------------------------------------------------------------------
  * Test Implementation
  *-----------------------------------------------------------------------------*/
@@ -378,6 +564,400 @@ void test_enum_range(void) {
     assert(count == ENUM_COUNT(COLOR));
 }
 
+/* Test dense member indices generated by the core macro */
+void test_dense_index(void) {
+    assert(STATUS_idx_total == 3);
+    assert(STATUS_idx_OK == 0);
+    assert(STATUS_idx_ERROR == 2);
+
+    assert(STATUS_get_index(OK) == 0);
+    assert(STATUS_get_index(NOT_FOUND) == 1);
+    assert(STATUS_get_index(ERROR) == 2);
+    assert(STATUS_get_index(201) == -1);
+
+    assert(STATUS_get_value(1) == NOT_FOUND);
+    assert(STATUS_get_value(3) == STATUS_total);
+    assert(STATUS_get_value(-1) == STATUS_total);
+
+    for (int i = 0; i < PRIORITY_idx_total; i++) {
+        assert(PRIORITY_get_index(PRIORITY_get_value(i)) == i);
+    }
+}
+
+/* Test ENUMS_HISTOGRAM and ENUMS_HISTOGRAM_MT
+ * Validates:
+ * - Counting through dense indices for sparse enums
+ * - Invalid values (gaps, negatives, past _total) are tallied separately
+ * - Tail handling for lengths that are not a multiple of the unroll
+ * - Multi-threaded results match the single-threaded kernel for any
+ *   thread count, including zero and negative counts */
+void test_histogram(void) {
+    const int vals[] = { OK, ERROR, OK, 201, NOT_FOUND, -7, OK, 9999, ERROR, OK, OK };
+    const size_t n = sizeof(vals) / sizeof(vals[0]);
+    uint64_t counts[STATUS_idx_total];
+    size_t invalid = 0;
+
+    STATUS_histogram(vals, n, counts, &invalid);
+    assert(counts[STATUS_get_index(OK)] == 5);
+    assert(counts[STATUS_get_index(NOT_FOUND)] == 1);
+    assert(counts[STATUS_get_index(ERROR)] == 2);
+    assert(invalid == 3);
+
+    STATUS_histogram(vals, 3, counts, NULL);
+    assert(counts[STATUS_idx_OK] == 2);
+    assert(counts[STATUS_idx_ERROR] == 1);
+
+    STATUS_histogram(vals, 0, counts, &invalid);
+    assert(counts[STATUS_idx_OK] == 0 && invalid == 0);
+
+    int big[1003];
+    for (int i = 0; i < 1003; i++) big[i] = (i % 5 == 0) ? 42 : STATUS_get_value(i % 3);
+    uint64_t expected[STATUS_idx_total];
+    size_t expected_invalid = 0;
+    STATUS_histogram(big, 1003, expected, &expected_invalid);
+    assert(expected_invalid == 201);
+
+    for (int threads = -2; threads <= 9; threads++) {
+        STATUS_histogram_mt(big, 1003, counts, &invalid, threads);
+        assert(memcmp(counts, expected, sizeof(expected)) == 0);
+        assert(invalid == expected_invalid);
+    }
+
+    const int colors[] = { BLUE, BLUE, RED, 3, BLUE };
+    uint64_t color_counts[COLOR_idx_total];
+    COLOR_histogram(colors, 5, color_counts, &invalid);
+    assert(color_counts[RED] == 1 && color_counts[GREEN] == 0 && color_counts[BLUE] == 3);
+    assert(invalid == 1);
+}
+
+/* Test ENUMS_CLASSIFY
+ * Validates:
+ * - Inclusive upper bounds and the NAME_total overflow result
+ * - Thresholds read from a non-zero column of an assigned enum
+ * - The batch variant matches the scalar classifier */
+void test_classify(void) {
+    assert(ENUM_COUNT(LATENCY) == 3);
+    assert(ENUM_COUNT(SIZE_BUCKET) == 3);
+
+    assert(LATENCY_classify(-5) == LAT_FAST);
+    assert(LATENCY_classify(10) == LAT_FAST);
+    assert(LATENCY_classify(11) == LAT_OK);
+    assert(LATENCY_classify(100) == LAT_OK);
+    assert(LATENCY_classify(999) == LAT_SLOW);
+    assert(LATENCY_classify(1001) == LATENCY_total);
+
+    assert(SIZE_BUCKET_classify(0.25) == SIZE_TINY);
+    assert(SIZE_BUCKET_classify(0.5) == SIZE_TINY);
+    assert(SIZE_BUCKET_classify(0.75) == SIZE_SMALL);
+    assert(SIZE_BUCKET_classify(4096.0) == SIZE_LARGE);
+    assert(SIZE_BUCKET_classify(1e9) == SIZE_BUCKET_total);
+
+    const int latencies[] = { 1, 50, 500, 5000, 10, 101 };
+    int buckets[6];
+    LATENCY_classify_batch(latencies, 6, buckets);
+    for (int i = 0; i < 6; i++) {
+        assert(buckets[i] == (int)LATENCY_classify(latencies[i]));
+    }
+    assert(buckets[3] == LATENCY_total);
+}
+
+/* Test ENUMS_FLAGS
+ * Validates:
+ * - Power-of-two value assignment and the full mask
+ * - Unknown bit detection
+ * - Combined mask formatting, truncation and round-trip parsing
+ * - Rejection of unknown or empty terms */
+void test_flags(void) {
+    assert(PERM_READ == 1);
+    assert(PERM_WRITE == 2);
+    assert(PERM_ADMIN == 8);
+    assert(PERM_all == 15);
+    assert(ENUM_COUNT(PERM) == 4);
+    assert(PERM_get_label(PERM_READ | PERM_WRITE) == NULL);
+
+    assert(PERM_is_valid_mask(PERM_READ | PERM_EXEC));
+    assert(PERM_is_valid_mask(0));
+    assert(!PERM_is_valid_mask(0x40));
+
+    char buf[64];
+    assert(PERM_format(PERM_READ | PERM_WRITE, buf, sizeof(buf)) == 20);
+    assert(strcmp(buf, "PERM_READ|PERM_WRITE") == 0);
+    PERM_format(PERM_ADMIN, buf, sizeof(buf));
+    assert(strcmp(buf, "PERM_ADMIN") == 0);
+    PERM_format(0, buf, sizeof(buf));
+    assert(strcmp(buf, "0") == 0);
+    PERM_format(PERM_EXEC | 0x40, buf, sizeof(buf));
+    assert(strcmp(buf, "PERM_EXEC|0x40") == 0);
+
+    char small[8];
+    assert(PERM_format(PERM_all, small, sizeof(small)) == 41);
+    assert(strcmp(small, "PERM_RE") == 0);
+    assert(PERM_format(PERM_all, NULL, 0) == 41);
+
+    unsigned mask = 0;
+    const char* text = "PERM_READ|PERM_WRITE";
+    assert(PERM_parse(text, strlen(text), &mask) && mask == (PERM_READ | PERM_WRITE));
+    text = " PERM_ADMIN | 0x40 |4";
+    assert(PERM_parse(text, strlen(text), &mask) && mask == (PERM_ADMIN | 0x40 | PERM_EXEC));
+    assert(PERM_parse("0", 1, &mask) && mask == 0);
+
+    for (unsigned m = 0; m < 64; m++) {
+        unsigned back = ~0u;
+        PERM_format(m, buf, sizeof(buf));
+        assert(PERM_parse(buf, strlen(buf), &back) && back == m);
+    }
+
+    mask = 7;
+    assert(!PERM_parse("PERM_READ|PERM_NONE", 19, &mask));
+    assert(!PERM_parse("PERM_READ||PERM_WRITE", 21, &mask));
+    assert(!PERM_parse("", 0, &mask));
+    assert(!PERM_parse("PERM_REA", 8, &mask));
+    assert(mask == 7);
+}
+
+/* Test ENUMS_FOREIGN_KEY
+ * Validates:
+ * - Forward mapping to the referenced enum value
+ * - Reverse member lists grouped per target, in list order
+ * - Targets without members and invalid inputs */
+void test_foreign_key(void) {
+    assert(ENUM_COUNT(SECTOR) == 4);
+    assert(ENUM_COUNT(TICKER) == 6);
+
+    assert(TICKER_get_sector_id(TK_AAPL) == SECTOR_TECH);
+    assert(TICKER_get_sector_id(TK_GS) == SECTOR_FIN);
+    assert(TICKER_get_sector_id(TK_LLY) == SECTOR_HEALTH);
+    assert(TICKER_get_sector_id(4) == SECTOR_total);
+    assert(strcmp(SECTOR_get_name(TICKER_get_sector_id(TK_JPM)), "Financials") == 0);
+
+    const int* members = NULL;
+    assert(TICKER_get_sector_members(SECTOR_TECH, &members) == 3);
+    assert(members[0] == TK_AAPL && members[1] == TK_MSFT && members[2] == TK_NVDA);
+    assert(TICKER_get_sector_members(SECTOR_FIN, &members) == 2);
+    assert(members[0] == TK_JPM && members[1] == TK_GS);
+    assert(TICKER_get_sector_members(SECTOR_HEALTH, &members) == 1);
+    assert(members[0] == TK_LLY);
+    assert(TICKER_get_sector_members(SECTOR_ENERGY, &members) == 0);
+    assert(TICKER_get_sector_members(11, &members) == 0 && members == NULL);
+
+    size_t total = 0;
+    for (int i = 0; i < SECTOR_idx_total; i++) {
+        size_t n = TICKER_get_sector_members(SECTOR_get_value(i), &members);
+        for (size_t k = 0; k < n; k++) {
+            assert(TICKER_get_sector_id(members[k]) == SECTOR_get_value(i));
+        }
+        total += n;
+    }
+    assert(total == (size_t)ENUM_COUNT(TICKER));
+}
+
+/* Test ENUM_DESCRIPTOR and ENUMS_REGISTRY
+ * Validates:
+ * - Descriptor contents (name, counts, value and label tables)
+ * - Lookup by id and by name, including unknown names
+ * - Generic label/value conversion and typed column access */
+void test_registry(void) {
+    assert(REGISTRY_idx_total == 4);
+    assert(REGISTRY_get(REGISTRY_idx_STATUS) == STATUS_get_descriptor());
+    assert(REGISTRY_get(4) == NULL);
+    assert(REGISTRY_get(-1) == NULL);
+
+    const enumfactory_descriptor* d = STATUS_get_descriptor();
+    assert(strcmp(d->name, "STATUS") == 0 && d->name_len == 6);
+    assert(d->count == 3 && d->total == 501);
+    assert(d->values[2] == ERROR);
+    assert(strcmp(d->labels[1], "NOT_FOUND") == 0);
+    assert(d->column_count == 0);
+
+    assert(REGISTRY_find("PRIORITY", 8) == PRIORITY_get_descriptor());
+    assert(REGISTRY_find_id("PERM", 4) == REGISTRY_idx_PERM);
+    assert(REGISTRY_find_id("COLOR", 5) == REGISTRY_idx_COLOR);
+    assert(REGISTRY_find("STATUSES", 8) == NULL);
+    assert(REGISTRY_find("STAT", 4) == NULL);
+    for (int id = 0; id < REGISTRY_idx_total; id++) {
+        const enumfactory_descriptor* e = REGISTRY_get(id);
+        assert(REGISTRY_find_id(e->name, e->name_len) == id);
+    }
+
+    d = REGISTRY_find("PERM", 4);
+    assert(strcmp(enumfactory_label(d, PERM_EXEC), "PERM_EXEC") == 0);
+    assert(enumfactory_label(d, 3) == NULL);
+    int value = -1;
+    assert(enumfactory_value(d, "PERM_ADMIN", 10, &value) && value == PERM_ADMIN);
+    assert(!enumfactory_value(d, "PERM_ADM", 8, &value));
+
+    d = REGISTRY_find("PRIORITY", 8);
+    assert(d->column_count == 3);
+    const enumfactory_column* col = enumfactory_column_find(d, "rate");
+    assert(col && col->kind == ENUMFACTORY_COLUMN_float);
+    assert(col->get.as_float(MEDIUM) == 0.11f);
+    col = enumfactory_column_find(d, "word");
+    assert(col && col->kind == ENUMFACTORY_COLUMN_string);
+    assert(strcmp(col->get.as_string(HIGH), "test1") == 0);
+    assert(enumfactory_column_find(d, "amount") == NULL);
+}
+
+/* Draws 64 VOLUME members from the calling thread's default generator */
+static void* sample_volume_worker(void* arg) {
+    VOLUME_sample_batch(NULL, (int*)arg, 64);
+    return NULL;
+}
+
+/* Test ENUMS_SAMPLER
+ * Validates:
+ * - Draw frequencies follow the weight column
+ * - Zero-weight members are never drawn
+ * - Seeded draws are reproducible and batch matches single draws
+ * - Concurrent first use builds the table once, and threads using the
+ *   default generator draw different sequences */
+void test_sampler(void) {
+    assert(ENUM_COUNT(SHARD) == 3);
+    assert(ENUM_COUNT(VOLUME) == 2);
+
+    pthread_t threads[4];
+    int drawn[4][64];
+    for (int t = 0; t < 4; t++) {
+        assert(pthread_create(&threads[t], NULL, sample_volume_worker, drawn[t]) == 0);
+    }
+    for (int t = 0; t < 4; t++) pthread_join(threads[t], NULL);
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < 64; i++) assert(ENUM_IS_VALID(VOLUME, drawn[t][i]));
+        for (int u = 0; u < t; u++) assert(memcmp(drawn[t], drawn[u], sizeof(drawn[t])) != 0);
+    }
+
+    enumfactory_rng rng;
+    enumfactory_rng_seed(&rng, 12345);
+    int hist[PRIORITY_total] = { 0 };
+    const int draws = 630000;
+    for (int i = 0; i < draws; i++) {
+        int v = PRIORITY_sample(&rng);
+        assert(ENUM_IS_VALID(PRIORITY, v));
+        hist[v]++;
+    }
+    /* Expected 330000 / 200000 / 100000; allow 1% of the total */
+    assert(hist[LOW] > 323700 && hist[LOW] < 336300);
+    assert(hist[MEDIUM] > 193700 && hist[MEDIUM] < 206300);
+    assert(hist[HIGH] > 93700 && hist[HIGH] < 106300);
+
+    int shards[10000];
+    SHARD_sample_batch(&rng, shards, 10000);
+    int shard_c = 0;
+    for (int i = 0; i < 10000; i++) {
+        assert(shards[i] != SHARD_B);
+        shard_c += shards[i] == SHARD_C;
+    }
+    assert(shard_c > 7200 && shard_c < 7800);
+
+    int first[64], second[64];
+    enumfactory_rng_seed(&rng, 7);
+    PRIORITY_sample_batch(&rng, first, 64);
+    enumfactory_rng_seed(&rng, 7);
+    for (int i = 0; i < 64; i++) second[i] = PRIORITY_sample(&rng);
+    assert(memcmp(first, second, sizeof(first)) == 0);
+
+    enumfactory_rng_seed(enumfactory_rng_local(), 7);
+    PRIORITY_sample_batch(NULL, second, 64);
+    assert(memcmp(first, second, sizeof(first)) == 0);
+
+    assert(PRIORITY_sampler_table()->n == 3);
+}
+
+/* Test ENUMS_STREAM
+ * Validates:
+ * - Window totals, rates and top-k after a simple sequence
+ * - Expiry when time advances, including gaps longer than the ring
+ * - Late and invalid events
+ * - Windows outside the configured ones read as empty
+ * - Running totals match a brute-force recount over a random stream */
+void test_stream(void) {
+    static STATUS_stream s;
+    const unsigned windows[] = { 1, 10, 60 };
+    assert(STATUS_stream_init(&s, 1000, windows, 0) == -1);
+    const unsigned too_wide[] = { 65 };
+    assert(STATUS_stream_init(&s, 1000, too_wide, 1) == -1);
+    assert(STATUS_stream_init(&s, 1000, windows, 3) == 0);
+
+    const uint64_t ts[] = { 0, 500, 1500, 9999, 9999, 9999 };
+    const int vals[] = { OK, ERROR, OK, NOT_FOUND, OK, 201 };
+    STATUS_stream_add_batch(&s, ts, vals, 6);
+    assert(s.invalid == 1);
+
+    uint64_t counts[STATUS_idx_total];
+    STATUS_stream_snapshot(&s, 0, counts);
+    assert(counts[STATUS_idx_OK] == 1 && counts[STATUS_idx_NOT_FOUND] == 1 && counts[STATUS_idx_ERROR] == 0);
+    STATUS_stream_snapshot(&s, 1, counts);
+    assert(counts[STATUS_idx_OK] == 3 && counts[STATUS_idx_ERROR] == 1);
+    assert(STATUS_stream_rate(&s, 1, OK) == 3.0 / 10000.0);
+    assert(STATUS_stream_rate(&s, 1, 201) == 0.0);
+
+    const char* labels[3];
+    int top_values[3];
+    uint64_t top_counts[3];
+    assert(STATUS_stream_top(&s, 1, 3, labels, top_values, top_counts) == 3);
+    assert(strcmp(labels[0], "OK") == 0 && top_values[0] == OK && top_counts[0] == 3);
+    assert(top_counts[1] == 1 && top_counts[2] == 1);
+    assert(STATUS_stream_top(&s, 0, 1, labels, NULL, NULL) == 1);
+    assert(STATUS_stream_top(&s, 1, 0, labels, NULL, NULL) == 0);
+
+    const int bad_windows[] = { -1, 3, ENUMS_STREAM_MAX_WINDOWS_ };
+    for (int i = 0; i < 3; i++) {
+        STATUS_stream_snapshot(&s, 0, counts);
+        STATUS_stream_snapshot(&s, bad_windows[i], counts);
+        for (int k = 0; k < STATUS_idx_total; k++) assert(counts[k] == 0);
+        assert(STATUS_stream_rate(&s, bad_windows[i], OK) == 0.0);
+        assert(STATUS_stream_top(&s, bad_windows[i], 3, labels, NULL, NULL) == 0);
+    }
+
+    /* 10s window now covers buckets 1..10: the event at bucket 0 expired */
+    STATUS_stream_advance(&s, 10000);
+    STATUS_stream_snapshot(&s, 1, counts);
+    assert(counts[STATUS_idx_OK] == 2 && counts[STATUS_idx_ERROR] == 0);
+    STATUS_stream_snapshot(&s, 0, counts);
+    assert(counts[STATUS_idx_OK] == 0 && counts[STATUS_idx_NOT_FOUND] == 0);
+
+    /* Late but inside the ring, then too late */
+    STATUS_stream_add(&s, 5000, ERROR);
+    STATUS_stream_snapshot(&s, 1, counts);
+    assert(counts[STATUS_idx_ERROR] == 1);
+    STATUS_stream_advance(&s, 70000);
+    STATUS_stream_add(&s, 1000, ERROR);
+    assert(s.late == 1);
+    STATUS_stream_snapshot(&s, 2, counts);
+    assert(counts[STATUS_idx_OK] == 0 && counts[STATUS_idx_ERROR] == 0);
+    assert(STATUS_stream_top(&s, 2, 3, labels, NULL, NULL) == 0);
+
+    /* Random stream against a brute-force recount of accepted events */
+    static uint64_t accepted_bucket[20000];
+    static int accepted_index[20000];
+    size_t accepted = 0;
+    enumfactory_rng rng;
+    enumfactory_rng_seed(&rng, 99);
+    STATUS_stream_init(&s, 100, windows, 3);
+    uint64_t now = 0;
+    for (int i = 0; i < 20000; i++) {
+        uint64_t r = enumfactory_rng_next(&rng);
+        now += (r & 0xFF) == 0 ? 9000 : (r >> 8) % 40;
+        uint64_t t = (r >> 16) % 8 == 0 && now > 3000 ? now - (r >> 24) % 3000 : now;
+        int value = STATUS_get_value((int)((r >> 40) % 3));
+        uint64_t late_before = s.late;
+        STATUS_stream_add(&s, t, value);
+        if (s.late == late_before) {
+            accepted_bucket[accepted] = t / 100;
+            accepted_index[accepted++] = STATUS_get_index(value);
+        }
+        if (i % 997 == 0) {
+            for (int w = 0; w < 3; w++) {
+                uint64_t expected[STATUS_idx_total] = { 0 };
+                for (size_t e = 0; e < accepted; e++) {
+                    if (accepted_bucket[e] + windows[w] > s.head) expected[accepted_index[e]]++;
+                }
+                STATUS_stream_snapshot(&s, w, counts);
+                assert(memcmp(counts, expected, sizeof(expected)) == 0);
+            }
+        }
+    }
+}
+
 /* Main test runner
  * Executes all test cases and reports results */
 int main(void) {
@@ -413,6 +993,30 @@ int main(void) {
     test_enum_range();
     printf("ENUM_BEGIN/ENUM_END range tests passed\n");
 
+    test_dense_index();
+    printf("Dense index tests passed\n");
+
+    test_histogram();
+    printf("Histogram tests passed\n");
+
+    test_classify();
+    printf("Classifier tests passed\n");
+
+    test_flags();
+    printf("Flag enum tests passed\n");
+
+    test_foreign_key();
+    printf("Foreign key tests passed\n");
+
+    test_registry();
+    printf("Registry tests passed\n");
+
+    test_sampler();
+    printf("Sampler tests passed\n");
+
+    test_stream();
+    printf("Streaming aggregation tests passed\n");
+
     print_fruit_values();
     print_color_values();
     print_status_values();